@@ -0,0 +1,42 @@
+# frozen_string_literal: true
+
+# Training and benchmark workload for the optimized build. It runs every
+# native entry point over the templates in benchmarks/corpus, scaled up so
+# each run spends most of its time in the extensions, and prints the best
+# wall-clock time out of a few rounds.
+#
+#   ruby -Ilib benchmarks/workload.rb [rounds]
+
+require "minihtml"
+
+CORPUS = Dir[File.join(__dir__, "corpus", "*.html")].map do |path|
+  File.read(path, encoding: Encoding::UTF_8)
+end
+DOCUMENTS = CORPUS.map { |source| "<div>#{source * 50}</div>" }
+INVALID = CORPUS.map { |source| "#{source}<p title=\"{{ broken" }
+
+def run_once
+  DOCUMENTS.each do |source|
+    MiniHTML::Scanner.new(source).tokenize
+    tree = MiniHTML::FlatTree.new(MiniHTML::Parser.new(source).parse)
+    tree.each_node { |node, _| node.position_start.line }
+    tree.find_all(name: "UI::Button", attr: "href")
+    MiniHTML::Scanner.new(source).tokenize(only: %i[executable interpolated_executable])
+    MiniHTML.index(source)
+  end
+
+  INVALID.each do |source|
+    scanner = MiniHTML::Scanner.new(source, fail_fast: true)
+    scanner.tokenize(only: [])
+    scanner.errors
+  end
+end
+
+rounds = Integer(ARGV.fetch(0, 5))
+best = Array.new(rounds) do
+  started = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+  5.times { run_once }
+  Process.clock_gettime(Process::CLOCK_MONOTONIC) - started
+end.min
+
+puts format("%.6f", best)
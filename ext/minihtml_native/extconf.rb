@@ -0,0 +1,25 @@
+# frozen_string_literal: true
+
+require "mkmf"
+
+append_cflags("-fvisibility=hidden")
+
+# MINIHTML_OPTIMIZE selects the profile-guided phase of the optimized build:
+# "generate" instruments the extension, and "use" rebuilds it from the
+# profiles collected by running the training workload. `rake optimize`
+# drives both phases.
+profile_dir = ENV.fetch("MINIHTML_PROFILE_DIR", File.expand_path("../../tmp/pgo", __dir__))
+
+case ENV.fetch("MINIHTML_OPTIMIZE", nil)
+when "generate"
+  append_cflags(["-O3", "-fprofile-generate=#{profile_dir}", "-fprofile-update=atomic"])
+  append_ldflags("-fprofile-generate=#{profile_dir}")
+when "use"
+  append_cflags(["-O3", "-fprofile-correction"])
+  # Added without append_cflags's probe: conftest.c has no profile of its
+  # own, so the probe's -Werror=missing-profile would always reject it.
+  $CFLAGS << " -fprofile-use=#{profile_dir}"
+  append_ldflags("-fprofile-use=#{profile_dir}")
+end
+
+create_makefile("minihtml/minihtml_native")
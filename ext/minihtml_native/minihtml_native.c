@@ -0,0 +1,13 @@
+// Unity build of every MiniHTML extension, used by the optimized build
+// (see `rake optimize`). Compiling all sources as a single translation unit
+// lets the compiler inline and lay out code across them, and gives PGO a
+// single profile to work with.
+#include "../minihtml_scanner/minihtml_scanner.c"
+#include "../minihtml_token_stream/minihtml_token_stream.c"
+#include "../minihtml_tree/minihtml_tree.c"
+
+RUBY_FUNC_EXPORTED void Init_minihtml_native(void) {
+    Init_minihtml_scanner();
+    Init_minihtml_token_stream();
+    Init_minihtml_tree();
+}
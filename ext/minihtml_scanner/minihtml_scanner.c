@@ -110,11 +110,15 @@ static inline bool scanner_is_tag_ident(const int v) {
 }
 
 static void scanner_free(void *ptr) {
+    const scanner_t *t = ptr;
+    xfree(t->line_starts);
+    xfree(t->errors);
     xfree(ptr);
 }
 
 static size_t scanner_memsize(const void *ptr) {
-    return sizeof(scanner_t);
+    const scanner_t *t = ptr;
+    return sizeof(scanner_t) + t->line_starts_cap * sizeof(long) + t->errors_cap * sizeof(scanner_error_t);
 }
 
 static void scanner_mark(void *ptr) {
@@ -123,7 +127,7 @@ static void scanner_mark(void *ptr) {
 
     if (scanner->tokens) rb_gc_mark(scanner->tokens);
 
-    if (scanner->errors) rb_gc_mark(scanner->errors);
+    if (scanner->refs) rb_gc_mark(scanner->refs);
 }
 
 static const rb_data_type_t scanner_type = {
@@ -138,8 +142,54 @@ static VALUE scanner_alloc(const VALUE klass) {
     return TypedData_Wrap_Struct(klass, &scanner_type, t);
 }
 
-static VALUE scanner_initialize(VALUE self, VALUE str) {
+static void scanner_push_line_start(scanner_t *t, const long offset) {
+    if (t->line_starts_len == t->line_starts_cap) {
+        t->line_starts_cap = t->line_starts_cap ? t->line_starts_cap * 2 : 64;
+        REALLOC_N(t->line_starts, long, t->line_starts_cap);
+    }
+    t->line_starts[t->line_starts_len++] = offset;
+}
+
+// Resolves a code point offset into its 1-based line and column by binary
+// searching the line start table. Positions are only needed on demand, so
+// the scanner itself just records where each line begins.
+static void line_starts_resolve(const long *starts, const long len, const long offset, long *line, long *col) {
+    long lo = 0, hi = len - 1;
+    while (lo < hi) {
+        const long mid = lo + (hi - lo + 1) / 2;
+        if (starts[mid] <= offset) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    *line = lo + 1;
+    *col = offset - starts[lo] + 1;
+}
+
+static VALUE line_starts_resolve_value(const long *starts, const long len, const long offset) {
+    long line, col;
+    line_starts_resolve(starts, len, offset, &line, &col);
+    return rb_assoc_new(LONG2FIX(line), LONG2FIX(col));
+}
+
+// Decodes the next code point into look[idx], remembering how many bytes it
+// took so idx_byte can follow idx_cp without re-decoding the source.
+static inline void scanner_read_lookahead(scanner_t *t, const int idx) {
+    const uint8_t *before = t->p;
+    t->look[idx] = next_utf8_cp(&t->p, t->end);
+    t->look_len[idx] = (int) (t->p - before);
+}
+
+static VALUE scanner_initialize(const int argc, VALUE *argv, const VALUE self) {
+    VALUE str, opts = Qnil, fail_fast = Qundef;
+    rb_scan_args(argc, argv, "1:", &str, &opts);
     Check_Type(str, T_STRING);
+    if (!NIL_P(opts)) {
+        const ID kw[1] = {id_type_fail_fast};
+        rb_get_kwargs(opts, kw, 0, 1, &fail_fast);
+    }
+
     scanner_t *t;
     TypedData_Get_Struct(self, scanner_t, &scanner_type, t);
 
@@ -148,16 +198,19 @@ static VALUE scanner_initialize(VALUE self, VALUE str) {
     t->p = (const uint8_t *) RSTRING_PTR(str);
     t->end = t->p + RSTRING_LEN(str);
     t->idx_cp = 0;
+    t->idx_byte = 0;
     t->tokens = rb_ary_new();
-    t->errors = rb_ary_new();
-    t->line = 1;
-    t->col = 1;
+    t->errors_len = 0;
+    t->fail_fast = fail_fast != Qundef && RTEST(fail_fast);
+    t->refs = Qnil;
+    t->line_starts_len = 0;
+    scanner_push_line_start(t, 0);
 
     // prime lookahead
-    t->look[0] = next_utf8_cp(&t->p, t->end);
-    t->look[1] = next_utf8_cp(&t->p, t->end);
-    t->look[2] = next_utf8_cp(&t->p, t->end);
-    t->look[3] = next_utf8_cp(&t->p, t->end);
+    scanner_read_lookahead(t, 0);
+    scanner_read_lookahead(t, 1);
+    scanner_read_lookahead(t, 2);
+    scanner_read_lookahead(t, 3);
 
     return self;
 }
@@ -166,13 +219,15 @@ static inline void rotate(scanner_t *t) {
     t->look[0] = t->look[1];
     t->look[1] = t->look[2];
     t->look[2] = t->look[3];
-    t->look[3] = next_utf8_cp(&t->p, t->end);
+    t->look_len[0] = t->look_len[1];
+    t->look_len[1] = t->look_len[2];
+    t->look_len[2] = t->look_len[3];
+    scanner_read_lookahead(t, 3);
 }
 
 static VALUE scanner_start_token(scanner_t *t) {
     t->start_token_offset = t->idx_cp;
-    t->start_token_line = t->line;
-    t->start_token_column = t->col;
+    t->start_token_byte = t->idx_byte;
     return Qnil;
 }
 
@@ -181,12 +236,8 @@ static void scanner_consume(scanner_t *t) {
     if (v == EOF_CP) return;
 
     t->idx_cp += 1;
-    if (v == NEWLINE) {
-        t->line += 1;
-        t->col = 1;
-    } else {
-        t->col += 1;
-    }
+    t->idx_byte += t->look_len[0];
+    if (v == NEWLINE) scanner_push_line_start(t, t->idx_cp);
 
     rotate(t);
 }
@@ -197,21 +248,130 @@ static void scanner_consume_tag_ident(scanner_t *t) {
     }
 }
 
-static void scanner_amend_last_token_kind(const scanner_t *t, const VALUE newKind) {
-    const VALUE v = rb_ary_entry(t->tokens, -1);
-    rb_hash_aset(v, sym_kind, newKind);
-}
-
-static void scanner_push_token_simple(const scanner_t *t, const VALUE type) {
+// only_kinds value matching no token kind at all; used by Scanner#index and
+// tokenize(only: []).
+#define SCANNER_ONLY_NONE (1u << 31)
+
+// Maps a token kind to its bit in scanner_t.only_kinds. Returns 0 for symbols
+// that are not token kinds.
+static uint32_t scanner_kind_bit(const VALUE kind) {
+    if (kind == sym_literal) return 1u << 0;
+    if (kind == sym_tag_begin) return 1u << 1;
+    if (kind == sym_tag_end) return 1u << 2;
+    if (kind == sym_tag_closing_start) return 1u << 3;
+    if (kind == sym_tag_closing_end) return 1u << 4;
+    if (kind == sym_right_angled) return 1u << 5;
+    if (kind == sym_attr_key) return 1u << 6;
+    if (kind == sym_equal) return 1u << 7;
+    if (kind == sym_string) return 1u << 8;
+    if (kind == sym_string_interpolation) return 1u << 9;
+    if (kind == sym_interpolated_executable) return 1u << 10;
+    if (kind == sym_executable) return 1u << 11;
+    if (kind == sym_tag_comment_end) return 1u << 12;
+    if (kind == sym_attr_value_unquoted) return 1u << 13;
+    return 0;
+}
+
+static inline bool scanner_wants(const scanner_t *t, const VALUE type) {
+    return !t->only_kinds || (t->only_kinds & scanner_kind_bit(type));
+}
+
+// Pushes a token spanning from the last scanner_start_token to the current
+// position. Tokens only carry code point offsets; line and column are
+// resolved through the line start table when needed.
+static VALUE scanner_push_token(const scanner_t *t, const VALUE type, const VALUE literal) {
     const VALUE h = rb_hash_new();
     rb_hash_aset(h, sym_kind, type);
-    rb_hash_aset(h, sym_start_line, LONG2FIX(t->start_token_line));
-    rb_hash_aset(h, sym_start_column, LONG2FIX(t->start_token_column));
     rb_hash_aset(h, sym_start_offset, LONG2FIX(t->start_token_offset));
-    rb_hash_aset(h, sym_end_line, LONG2FIX(t->line));
-    rb_hash_aset(h, sym_end_column, LONG2FIX(t->col));
     rb_hash_aset(h, sym_end_offset, LONG2FIX(t->idx_cp));
+    rb_hash_aset(h, sym_literal, literal);
     rb_ary_push(t->tokens, h);
+    return h;
+}
+
+// Pushes a token of the given kind, returning its hash, or Qnil when the kind
+// was filtered out through tokenize(only:). State is tracked regardless.
+static VALUE scanner_push_token_simple(const scanner_t *t, const VALUE type) {
+    if (!scanner_wants(t, type)) return Qnil;
+    const VALUE literal = rb_str_subseq(t->str, t->start_token_byte, t->idx_byte - t->start_token_byte);
+    return scanner_push_token(t, type, literal);
+}
+
+// Returns the frozen, deduplicated string for the given byte range of the
+// source. Ruby keeps a single instance per content, so every document sharing
+// a tag name or attribute key ends up sharing the very same object.
+static inline VALUE scanner_intern_range(const scanner_t *t, const long from, const long to) {
+    return rb_enc_interned_str(RSTRING_PTR(t->str) + from, to - from, rb_enc_get(t->str));
+}
+
+// Pushes a token whose literal is interned instead of sliced from the source.
+// Used for tag and attribute names, which repeat heavily across templates.
+static VALUE scanner_push_token_interned(const scanner_t *t, const VALUE type) {
+    if (!scanner_wants(t, type)) return Qnil;
+    return scanner_push_token(t, type, scanner_intern_range(t, t->start_token_byte, t->idx_byte));
+}
+
+// Records a reference to the tag name that has just been scanned into
+// t->refs, counting every occurrence and keeping the position of the first.
+static void scanner_record_ref(const scanner_t *t) {
+    const VALUE name = scanner_intern_range(t, t->start_token_byte + 1, t->idx_byte);
+    const VALUE entry = rb_hash_aref(t->refs, name);
+    if (!NIL_P(entry)) {
+        rb_hash_aset(entry, sym_count, LONG2FIX(FIX2LONG(rb_hash_aref(entry, sym_count)) + 1));
+        return;
+    }
+
+    long line, col;
+    line_starts_resolve(t->line_starts, t->line_starts_len, t->start_token_offset, &line, &col);
+
+    const VALUE h = rb_hash_new();
+    rb_hash_aset(h, sym_count, LONG2FIX(1));
+    rb_hash_aset(h, sym_line, LONG2FIX(line));
+    rb_hash_aset(h, sym_column, LONG2FIX(col));
+    rb_hash_aset(h, sym_offset, LONG2FIX(t->start_token_offset));
+    rb_hash_aset(t->refs, name, h);
+}
+
+// Pushes a tag_begin or tag_closing_start token, also storing the interned
+// tag name (the literal without its `<` or `</` prefix) under :name.
+static void scanner_push_token_tag(const scanner_t *t, const VALUE type, const long prefixLen) {
+    if (!NIL_P(t->refs)) {
+        if (type == sym_tag_begin) scanner_record_ref(t);
+        return;
+    }
+
+    const VALUE h = scanner_push_token_interned(t, type);
+    if (NIL_P(h)) return;
+    rb_hash_aset(h, sym_name, scanner_intern_range(t, t->start_token_byte + prefixLen, t->idx_byte));
+}
+
+// Makes every lookahead slot report EOF, so all scanning loops unwind
+// without consuming anything else.
+static void scanner_halt(scanner_t *t) {
+    t->p = t->end;
+    for (int i = 0; i < 4; i++) {
+        t->look[i] = EOF_CP;
+        t->look_len[i] = 0;
+    }
+}
+
+// Records an error at the current offset. Errors are kept as code/offset
+// pairs and only turned into messages when read through Scanner#errors.
+// In fail_fast mode the first error also halts the scanner; returns whether
+// it is halted, in which case callers must not push further tokens.
+static bool scanner_push_error(scanner_t *t, const scanner_error_code_t code) {
+    if (t->fail_fast && t->errors_len > 0) return true;
+
+    if (t->errors_len == t->errors_cap) {
+        t->errors_cap = t->errors_cap ? t->errors_cap * 2 : 4;
+        REALLOC_N(t->errors, scanner_error_t, t->errors_cap);
+    }
+    t->errors[t->errors_len].code = code;
+    t->errors[t->errors_len].offset = t->idx_cp;
+    t->errors_len++;
+
+    if (t->fail_fast) scanner_halt(t);
+    return t->fail_fast;
 }
 
 static inline void scanner_consume_spaces(scanner_t *t) {
@@ -220,7 +380,7 @@ static inline void scanner_consume_spaces(scanner_t *t) {
     }
 }
 
-static void scanner_consume_executable(scanner_t *t) {
+static void scanner_consume_executable(scanner_t *t, const VALUE kind) {
     scanner_consume(t); // {
     scanner_consume(t); // {
     scanner_start_token(t);
@@ -228,7 +388,7 @@ static void scanner_consume_executable(scanner_t *t) {
     int bracketLevel = 0;
     while (t->look[0] != EOF_CP) {
         if (bracketLevel == 0 && t->look[0] == CURLY_RIGHT && t->look[1] == CURLY_RIGHT) {
-            scanner_push_token_simple(t, sym_executable);
+            scanner_push_token_simple(t, kind);
             scanner_consume(t); // }
             scanner_consume(t); // }
             return;
@@ -239,13 +399,11 @@ static void scanner_consume_executable(scanner_t *t) {
 
         scanner_consume(t);
     }
-    char errStr[128] = {0};
-    snprintf(errStr, 127, "Unmatched {{ block at line %lu, column %lu, offset %lu", t->line, t->col, t->idx_cp);
-    rb_ary_push(t->errors, rb_str_new_cstr(errStr));
+    scanner_push_error(t, SCANNER_ERROR_UNMATCHED_EXECUTABLE);
 }
 
-static void scanner_set_string_quote_value(const scanner_t *t, const char quoteChar) {
-    const VALUE token = rb_ary_entry(t->tokens, -1);
+static void scanner_set_string_quote_value(const VALUE token, const char quoteChar) {
+    if (NIL_P(token)) return;
     const char value[2] = {quoteChar, 0};
     rb_hash_aset(token, sym_quote_char, rb_str_new_cstr(value));
 }
@@ -259,26 +417,20 @@ static void scanner_consume_string(scanner_t *t) {
             scanner_consume(t); // '\'
             scanner_consume(t); // quoteChar
         } else if (t->look[0] == quoteChar) {
-            scanner_push_token_simple(t, sym_string);
-            scanner_set_string_quote_value(t, (char)quoteChar);
+            scanner_set_string_quote_value(scanner_push_token_simple(t, sym_string), (char)quoteChar);
             scanner_consume(t);
             return;
         } else if (t->look[0] == CURLY_LEFT && t->look[1] == CURLY_LEFT) {
-            scanner_push_token_simple(t, sym_string_interpolation);
-            scanner_set_string_quote_value(t, (char)quoteChar);
-            scanner_consume_executable(t);
-            scanner_amend_last_token_kind(t, sym_interpolated_executable);
+            scanner_set_string_quote_value(scanner_push_token_simple(t, sym_string_interpolation), (char)quoteChar);
+            scanner_consume_executable(t, sym_interpolated_executable);
             scanner_start_token(t);
         } else {
             scanner_consume(t);
         }
     }
 
-    char errStr[128] = {0};
-    snprintf(errStr, 127, "Unterminated string value at line %lu, column %lu, offset %lu", t->line, t->col, t->idx_cp);
-    rb_ary_push(t->errors, rb_str_new_cstr(errStr));
-    scanner_push_token_simple(t, sym_string);
-    scanner_set_string_quote_value(t, (char)quoteChar);
+    if (scanner_push_error(t, SCANNER_ERROR_UNTERMINATED_STRING)) return;
+    scanner_set_string_quote_value(scanner_push_token_simple(t, sym_string), (char)quoteChar);
 }
 
 static inline bool scanner_is_attr_ident(const int p) {
@@ -306,7 +458,7 @@ static void scanner_consume_unquoted_attr_value(scanner_t *t) {
 static void scanner_consume_attr(scanner_t *t) {
     scanner_start_token(t);
     scanner_consume_attr_name(t);
-    scanner_push_token_simple(t, sym_attr_key);
+    scanner_push_token_interned(t, sym_attr_key);
     scanner_consume_spaces(t);
     if (t->look[0] == EQUAL) {
         scanner_start_token(t);
@@ -320,7 +472,7 @@ static void scanner_consume_attr(scanner_t *t) {
                 break;
             case CURLY_LEFT:
                 if (t->look[1] == CURLY_LEFT) {
-                    scanner_consume_executable(t);
+                    scanner_consume_executable(t, sym_executable);
                     break;
                 }
             default:
@@ -344,9 +496,7 @@ static void scanner_consume_comment_tag(scanner_t *t) {
     }
 
     // If we reach this point, it's an error.
-    char errStr[128] = {0};
-    snprintf(errStr, 127, "Unterminated comment tag at line %lu, column %lu, offset %lu", t->line, t->col, t->idx_cp);
-    rb_ary_push(t->errors, rb_str_new_cstr(errStr));
+    if (scanner_push_error(t, SCANNER_ERROR_UNTERMINATED_COMMENT)) return;
     scanner_push_token_simple(t, sym_tag_comment_end);
 }
 
@@ -366,7 +516,7 @@ static void scanner_scan_open_tag(scanner_t *t) {
         scanner_start_token(t);
         scanner_consume(t); // <
         scanner_consume_tag_ident(t); // \w
-        scanner_push_token_simple(t, sym_tag_begin);
+        scanner_push_token_tag(t, sym_tag_begin, 1);
 
         scanner_consume_spaces(t);
         while (scanner_is_letter(t->look[0])) {
@@ -384,7 +534,7 @@ static void scanner_scan_open_tag(scanner_t *t) {
         if (scanner_is_tag_ident(t->look[0])) {
             scanner_consume_tag_ident(t);
         }
-        scanner_push_token_simple(t, sym_tag_closing_start);
+        scanner_push_token_tag(t, sym_tag_closing_start, 2);
         scanner_consume_spaces(t);
         while (scanner_is_tag_ident(t->look[0])) {
             scanner_consume_attr(t);
@@ -448,7 +598,7 @@ static VALUE scanner_scan_token(scanner_t *t) {
             break;
         case CURLY_LEFT:
             if (t->look[1] == CURLY_LEFT) {
-                scanner_consume_executable(t);
+                scanner_consume_executable(t, sym_executable);
             } else {
                 scanner_consume_literal(t);
             }
@@ -469,18 +619,80 @@ static VALUE scanner_tokens(const VALUE self) {
     return t->tokens;
 }
 
+static const char *scanner_error_message(const scanner_error_code_t code) {
+    switch (code) {
+        case SCANNER_ERROR_UNMATCHED_EXECUTABLE:
+            return "Unmatched {{ block";
+        case SCANNER_ERROR_UNTERMINATED_STRING:
+            return "Unterminated string value";
+        case SCANNER_ERROR_UNTERMINATED_COMMENT:
+            return "Unterminated comment tag";
+    }
+    return "Unknown error";
+}
+
+static VALUE scanner_error_symbol(const scanner_error_code_t code) {
+    switch (code) {
+        case SCANNER_ERROR_UNMATCHED_EXECUTABLE:
+            return sym_unmatched_executable;
+        case SCANNER_ERROR_UNTERMINATED_STRING:
+            return sym_unterminated_string;
+        case SCANNER_ERROR_UNTERMINATED_COMMENT:
+            return sym_unterminated_comment;
+    }
+    return Qnil;
+}
+
 static VALUE scanner_errors(const VALUE self) {
     scanner_t *t;
     TypedData_Get_Struct(self, scanner_t, &scanner_type, t);
-    return t->errors;
+
+    const VALUE result = rb_ary_new_capa(t->errors_len);
+    for (long i = 0; i < t->errors_len; i++) {
+        const scanner_error_t *e = &t->errors[i];
+        long line, col;
+        line_starts_resolve(t->line_starts, t->line_starts_len, e->offset, &line, &col);
+        rb_ary_push(result, rb_sprintf("%s at line %ld, column %ld, offset %ld",
+                                       scanner_error_message(e->code), line, col, e->offset));
+    }
+    return result;
+}
+
+static VALUE scanner_error_details(const VALUE self) {
+    scanner_t *t;
+    TypedData_Get_Struct(self, scanner_t, &scanner_type, t);
+
+    const VALUE result = rb_ary_new_capa(t->errors_len);
+    for (long i = 0; i < t->errors_len; i++) {
+        const scanner_error_t *e = &t->errors[i];
+        long line, col;
+        line_starts_resolve(t->line_starts, t->line_starts_len, e->offset, &line, &col);
+
+        const VALUE h = rb_hash_new();
+        rb_hash_aset(h, sym_code, scanner_error_symbol(e->code));
+        rb_hash_aset(h, sym_line, LONG2FIX(line));
+        rb_hash_aset(h, sym_column, LONG2FIX(col));
+        rb_hash_aset(h, sym_offset, LONG2FIX(e->offset));
+        rb_ary_push(result, h);
+    }
+    return result;
+}
+
+static VALUE scanner_has_errors(const VALUE self) {
+    scanner_t *t;
+    TypedData_Get_Struct(self, scanner_t, &scanner_type, t);
+    return t->errors_len > 0 ? Qtrue : Qfalse;
 }
 
 static VALUE scanner_stats(const VALUE self) {
     scanner_t *t;
     TypedData_Get_Struct(self, scanner_t, &scanner_type, t);
+    long line, col;
+    line_starts_resolve(t->line_starts, t->line_starts_len, t->idx_cp, &line, &col);
+
     const VALUE h = rb_hash_new();
-    rb_hash_aset(h, sym_line, LONG2NUM(t->line));
-    rb_hash_aset(h, sym_column, LONG2NUM(t->col));
+    rb_hash_aset(h, sym_line, LONG2NUM(line));
+    rb_hash_aset(h, sym_column, LONG2NUM(col));
     rb_hash_aset(h, sym_offset, LONG2NUM(t->idx_cp));
     return h;
 }
@@ -491,30 +703,114 @@ static VALUE scanner_at_eof(const VALUE self) {
     return t->look[0] == EOF ? Qtrue : Qfalse;
 }
 
-static void scanner_hydrate_tokens(const scanner_t *t) {
-    const long len = RARRAY_LEN(t->tokens);
+static VALUE scanner_line_column(const VALUE self, const VALUE offset) {
+    scanner_t *t;
+    TypedData_Get_Struct(self, scanner_t, &scanner_type, t);
+    return line_starts_resolve_value(t->line_starts, t->line_starts_len, NUM2LONG(offset));
+}
+
+static void line_index_free(void *ptr) {
+    const line_index_t *li = ptr;
+    xfree(li->starts);
+    xfree(ptr);
+}
+
+static size_t line_index_memsize(const void *ptr) {
+    const line_index_t *li = ptr;
+    return sizeof(line_index_t) + li->len * sizeof(long);
+}
+
+static const rb_data_type_t line_index_type = {
+    "MiniHTML::LineIndex",
+    {0, line_index_free, line_index_memsize},
+    0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE line_index_alloc(const VALUE klass) {
+    line_index_t *li = ALLOC(line_index_t);
+    memset(li, 0, sizeof(line_index_t));
+    return TypedData_Wrap_Struct(klass, &line_index_type, li);
+}
+
+static VALUE line_index_line_column(const VALUE self, const VALUE offset) {
+    line_index_t *li;
+    TypedData_Get_Struct(self, line_index_t, &line_index_type, li);
+    return line_starts_resolve_value(li->starts, li->len, NUM2LONG(offset));
+}
+
+static VALUE line_index_line_count(const VALUE self) {
+    line_index_t *li;
+    TypedData_Get_Struct(self, line_index_t, &line_index_type, li);
+    return LONG2FIX(li->len);
+}
+
+static VALUE rb_cLineIndex;
+
+// Returns a MiniHTML::LineIndex holding a copy of the line start table built
+// so far, so AST positions can resolve lines without keeping the scanner and
+// its tokens alive.
+static VALUE scanner_line_index(const VALUE self) {
+    scanner_t *t;
+    TypedData_Get_Struct(self, scanner_t, &scanner_type, t);
+
+    const VALUE v = line_index_alloc(rb_cLineIndex);
+    line_index_t *li;
+    TypedData_Get_Struct(v, line_index_t, &line_index_type, li);
+    li->starts = ALLOC_N(long, t->line_starts_len);
+    MEMCPY(li->starts, t->line_starts, long, t->line_starts_len);
+    li->len = t->line_starts_len;
+    return v;
+}
+
+static uint32_t scanner_parse_only_kinds(VALUE only) {
+    if (NIL_P(only)) return 0;
+    if (SYMBOL_P(only)) only = rb_ary_new_from_args(1, only);
+    Check_Type(only, T_ARRAY);
+    if (RARRAY_LEN(only) == 0) return SCANNER_ONLY_NONE;
+
+    uint32_t mask = 0;
+    const long len = RARRAY_LEN(only);
     for (long i = 0; i < len; i++) {
-        const VALUE v = rb_ary_entry(t->tokens, i);
-        const long startOffset = NUM2LONG(rb_hash_aref(v, sym_start_offset));
-        const long endOffset = NUM2LONG(rb_hash_aref(v, sym_end_offset));
-        const long strLen = endOffset - startOffset;
-        if (strLen < 0) {
-            rb_raise(rb_eRuntimeError, "invalid offset boundaries %ld -> %ld", startOffset, endOffset);
+        const VALUE kind = rb_ary_entry(only, i);
+        const uint32_t bit = SYMBOL_P(kind) ? scanner_kind_bit(kind) : 0;
+        if (!bit) {
+            rb_raise(rb_eArgError, "unknown token kind %" PRIsVALUE, rb_inspect(kind));
         }
-        rb_hash_aset(v, sym_literal, rb_str_substr(t->str, startOffset, strLen));
+        mask |= bit;
     }
+    return mask;
 }
 
-static VALUE scanner_tokenize(const VALUE self) {
+static VALUE scanner_tokenize(const int argc, VALUE *argv, const VALUE self) {
     scanner_t *t;
     TypedData_Get_Struct(self, scanner_t, &scanner_type, t);
+
+    VALUE opts = Qnil, only = Qundef;
+    rb_scan_args(argc, argv, ":", &opts);
+    if (!NIL_P(opts)) {
+        const ID kw[1] = {id_type_only};
+        rb_get_kwargs(opts, kw, 0, 1, &only);
+    }
+    t->only_kinds = scanner_parse_only_kinds(only == Qundef ? Qnil : only);
+
     while (t->look[0] != EOF) {
         scanner_scan_token(t);
     }
-    scanner_hydrate_tokens(t);
     return t->tokens;
 }
 
+static VALUE scanner_index(const VALUE self) {
+    scanner_t *t;
+    TypedData_Get_Struct(self, scanner_t, &scanner_type, t);
+
+    t->refs = rb_hash_new();
+    t->only_kinds = SCANNER_ONLY_NONE;
+    while (t->look[0] != EOF) {
+        scanner_scan_token(t);
+    }
+    return t->refs;
+}
+
 RUBY_FUNC_EXPORTED void Init_minihtml_scanner(void) {
     VALUE rb_mMiniHTML = rb_define_module("MiniHTML");
     VALUE rb_cScanner = rb_define_class_under(rb_mMiniHTML, "Scanner", rb_cObject);
@@ -522,14 +818,11 @@ RUBY_FUNC_EXPORTED void Init_minihtml_scanner(void) {
     INITIALIZE_REUSABLE_SYMBOL(line);
     INITIALIZE_REUSABLE_SYMBOL(column);
     INITIALIZE_REUSABLE_SYMBOL(offset);
-    INITIALIZE_REUSABLE_SYMBOL(start_line);
-    INITIALIZE_REUSABLE_SYMBOL(start_column);
     INITIALIZE_REUSABLE_SYMBOL(start_offset);
-    INITIALIZE_REUSABLE_SYMBOL(end_line);
-    INITIALIZE_REUSABLE_SYMBOL(end_column);
     INITIALIZE_REUSABLE_SYMBOL(end_offset);
     INITIALIZE_REUSABLE_SYMBOL(new);
     INITIALIZE_REUSABLE_SYMBOL(literal);
+    INITIALIZE_REUSABLE_SYMBOL(name);
     INITIALIZE_REUSABLE_SYMBOL(self_closing);
     INITIALIZE_REUSABLE_SYMBOL(tag_begin);
     INITIALIZE_REUSABLE_SYMBOL(tag_end);
@@ -546,12 +839,30 @@ RUBY_FUNC_EXPORTED void Init_minihtml_scanner(void) {
     INITIALIZE_REUSABLE_SYMBOL(quote_char);
     INITIALIZE_REUSABLE_SYMBOL(tag_comment_end);
     INITIALIZE_REUSABLE_SYMBOL(attr_value_unquoted);
+    INITIALIZE_REUSABLE_SYMBOL(only);
+    INITIALIZE_REUSABLE_SYMBOL(count);
+    INITIALIZE_REUSABLE_SYMBOL(fail_fast);
+    INITIALIZE_REUSABLE_SYMBOL(code);
+    INITIALIZE_REUSABLE_SYMBOL(unmatched_executable);
+    INITIALIZE_REUSABLE_SYMBOL(unterminated_string);
+    INITIALIZE_REUSABLE_SYMBOL(unterminated_comment);
 
     rb_define_alloc_func(rb_cScanner, scanner_alloc);
-    rb_define_method(rb_cScanner, "initialize", scanner_initialize, 1);
+    rb_define_method(rb_cScanner, "initialize", scanner_initialize, -1);
     rb_define_method(rb_cScanner, "tokens", scanner_tokens, 0);
     rb_define_method(rb_cScanner, "errors", scanner_errors, 0);
+    rb_define_method(rb_cScanner, "error_details", scanner_error_details, 0);
+    rb_define_method(rb_cScanner, "errors?", scanner_has_errors, 0);
     rb_define_method(rb_cScanner, "stats", scanner_stats, 0);
     rb_define_method(rb_cScanner, "eof?", scanner_at_eof, 0);
-    rb_define_method(rb_cScanner, "tokenize", scanner_tokenize, 0);
+    rb_define_method(rb_cScanner, "tokenize", scanner_tokenize, -1);
+    rb_define_method(rb_cScanner, "index", scanner_index, 0);
+    rb_define_method(rb_cScanner, "line_column", scanner_line_column, 1);
+    rb_define_method(rb_cScanner, "line_index", scanner_line_index, 0);
+
+    rb_cLineIndex = rb_define_class_under(rb_mMiniHTML, "LineIndex", rb_cObject);
+    rb_global_variable(&rb_cLineIndex);
+    rb_undef_alloc_func(rb_cLineIndex);
+    rb_define_method(rb_cLineIndex, "line_column", line_index_line_column, 1);
+    rb_define_method(rb_cLineIndex, "line_count", line_index_line_count, 0);
 }
@@ -30,14 +30,11 @@
 DEFINE_REUSABLE_SYMBOL(line);
 DEFINE_REUSABLE_SYMBOL(column);
 DEFINE_REUSABLE_SYMBOL(offset);
-DEFINE_REUSABLE_SYMBOL(start_line);
-DEFINE_REUSABLE_SYMBOL(start_column);
 DEFINE_REUSABLE_SYMBOL(start_offset);
-DEFINE_REUSABLE_SYMBOL(end_line);
-DEFINE_REUSABLE_SYMBOL(end_column);
 DEFINE_REUSABLE_SYMBOL(end_offset);
 DEFINE_REUSABLE_SYMBOL(new);
 DEFINE_REUSABLE_SYMBOL(literal);
+DEFINE_REUSABLE_SYMBOL(name);
 DEFINE_REUSABLE_SYMBOL(self_closing);
 DEFINE_REUSABLE_SYMBOL(tag_begin);
 DEFINE_REUSABLE_SYMBOL(tag_end);
@@ -54,20 +51,50 @@ DEFINE_REUSABLE_SYMBOL(equal);
 DEFINE_REUSABLE_SYMBOL(quote_char);
 DEFINE_REUSABLE_SYMBOL(tag_comment_end);
 DEFINE_REUSABLE_SYMBOL(attr_value_unquoted);
+DEFINE_REUSABLE_SYMBOL(only);
+DEFINE_REUSABLE_SYMBOL(count);
+DEFINE_REUSABLE_SYMBOL(fail_fast);
+DEFINE_REUSABLE_SYMBOL(code);
+DEFINE_REUSABLE_SYMBOL(unmatched_executable);
+DEFINE_REUSABLE_SYMBOL(unterminated_string);
+DEFINE_REUSABLE_SYMBOL(unterminated_comment);
+
+typedef enum {
+    SCANNER_ERROR_UNMATCHED_EXECUTABLE,
+    SCANNER_ERROR_UNTERMINATED_STRING,
+    SCANNER_ERROR_UNTERMINATED_COMMENT,
+} scanner_error_code_t;
+
+typedef struct {
+    scanner_error_code_t code;
+    long offset;
+} scanner_error_t;
 
 typedef struct {
     VALUE str;
     VALUE tokens;
-    VALUE errors;
+    VALUE refs;
+    uint32_t only_kinds;
+    bool fail_fast;
+    scanner_error_t *errors;
+    long errors_len;
+    long errors_cap;
     const uint8_t *p;
     const uint8_t *end;
     long idx_cp;
     int look[4];
-    long line;
-    long col;
+    int look_len[4];
+    long idx_byte;
     long start_token_offset;
-    long start_token_line;
-    long start_token_column;
+    long start_token_byte;
+    long *line_starts;
+    long line_starts_len;
+    long line_starts_cap;
 } scanner_t;
 
+typedef struct {
+    long *starts;
+    long len;
+} line_index_t;
+
 #endif /* MINIHTML_H */
@@ -59,7 +59,7 @@ static VALUE stream_initialize(const VALUE self, VALUE tokens) {
     return self;
 }
 
-static void rotate(stream_t *s) {
+static void stream_rotate(stream_t *s) {
     s->look[0] = s->look[1];
     s->look[1] = s->tokens_idx + 1 < s->tokens_len ? rb_ary_entry(s->tokens, s->tokens_idx + 1) : Qnil;
 }
@@ -80,7 +80,7 @@ static void stream_consume_c(stream_t *s) {
     if (s->tokens_idx < s->tokens_len && s->tokens_idx + 1 < s->tokens_len) {
         s->tokens_idx++;
     }
-    rotate(s);
+    stream_rotate(s);
 }
 
 static VALUE stream_consume(const VALUE self) {
@@ -0,0 +1,348 @@
+#include "ruby.h"
+#include <stdint.h>
+#include <string.h>
+
+#define DEFINE_REUSABLE_SYMBOL(name) static ID id_type_##name; static VALUE sym_##name;
+#define INITIALIZE_REUSABLE_SYMBOL(name) id_type_##name = rb_intern(#name); sym_##name = ID2SYM(id_type_##name);
+
+DEFINE_REUSABLE_SYMBOL(name);
+DEFINE_REUSABLE_SYMBOL(attr);
+DEFINE_REUSABLE_SYMBOL(within);
+
+static ID id_ivar_name;
+static ID id_ivar_children;
+static ID id_ivar_attributes;
+static ID id_ivar_value;
+static ID id_ivar_literal;
+
+#define NO_NODE (-1)
+
+// A node of the flattened tree. Nodes are stored in pre-order, so the
+// descendants of node i are exactly the nodes in [i + 1, subtree_end).
+typedef struct {
+    VALUE name;         // interned tag name, or Qnil for non-tag nodes
+    long parent;
+    long first_child;
+    long next_sibling;
+    long subtree_end;
+    long attr_start;
+    long attr_len;
+} tree_node_t;
+
+typedef struct {
+    VALUE key;          // interned attribute key
+    VALUE literal;      // value literal for String and Literal values, Qnil otherwise
+} tree_attr_t;
+
+typedef struct {
+    VALUE nodes;        // AST nodes, in the same order as `flat`
+    tree_node_t *flat;
+    long flat_len;
+    long flat_cap;
+    tree_attr_t *attrs;
+    long attrs_len;
+    long attrs_cap;
+} tree_t;
+
+static void tree_free(void *ptr) {
+    tree_t *tr = ptr;
+    xfree(tr->flat);
+    xfree(tr->attrs);
+    xfree(tr);
+}
+
+static size_t tree_memsize(const void *ptr) {
+    const tree_t *tr = ptr;
+    return sizeof(tree_t) + tr->flat_cap * sizeof(tree_node_t) + tr->attrs_cap * sizeof(tree_attr_t);
+}
+
+static void tree_mark(void *ptr) {
+    const tree_t *tr = ptr;
+    if (tr->nodes) rb_gc_mark(tr->nodes);
+    for (long i = 0; i < tr->flat_len; i++) {
+        rb_gc_mark(tr->flat[i].name);
+    }
+    for (long i = 0; i < tr->attrs_len; i++) {
+        rb_gc_mark(tr->attrs[i].key);
+        rb_gc_mark(tr->attrs[i].literal);
+    }
+}
+
+static const rb_data_type_t tree_type = {
+    "MiniHTML::FlatTree",
+    {tree_mark, tree_free, tree_memsize,},
+    0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE tree_alloc(const VALUE klass) {
+    tree_t *tr = ALLOC(tree_t);
+    memset(tr, 0, sizeof(tree_t));
+    return TypedData_Wrap_Struct(klass, &tree_type, tr);
+}
+
+#define UNWRAP_TREE tree_t *tr; TypedData_Get_Struct(self, tree_t, &tree_type, tr);
+
+static VALUE tree_attr_literal(const VALUE value) {
+    if (NIL_P(value)) return Qnil;
+    VALUE lit = rb_ivar_get(value, id_ivar_literal);
+    if (RB_TYPE_P(lit, T_STRING)) return lit;
+    lit = rb_ivar_get(value, id_ivar_value);
+    return RB_TYPE_P(lit, T_STRING) ? lit : Qnil;
+}
+
+static void tree_push_attrs(tree_t *tr, tree_node_t *n, const VALUE attributes) {
+    n->attr_start = tr->attrs_len;
+    if (!RB_TYPE_P(attributes, T_ARRAY)) return;
+
+    const long len = RARRAY_LEN(attributes);
+    for (long i = 0; i < len; i++) {
+        const VALUE attr = rb_ary_entry(attributes, i);
+        if (tr->attrs_len == tr->attrs_cap) {
+            tr->attrs_cap = tr->attrs_cap ? tr->attrs_cap * 2 : 16;
+            REALLOC_N(tr->attrs, tree_attr_t, tr->attrs_cap);
+        }
+        tree_attr_t *a = &tr->attrs[tr->attrs_len];
+        a->key = rb_ivar_get(attr, id_ivar_name);
+        a->literal = tree_attr_literal(rb_ivar_get(attr, id_ivar_value));
+        tr->attrs_len++;
+        n->attr_len++;
+    }
+}
+
+// Appends node and its descendants in pre-order, returning its index.
+static long tree_push(tree_t *tr, const VALUE node, const long parent) {
+    if (tr->flat_len == tr->flat_cap) {
+        tr->flat_cap = tr->flat_cap ? tr->flat_cap * 2 : 64;
+        REALLOC_N(tr->flat, tree_node_t, tr->flat_cap);
+    }
+
+    // The slot must be fully initialized before flat_len covers it, as any
+    // allocation below may run GC and, with it, tree_mark.
+    const long idx = tr->flat_len;
+    tree_node_t *n = &tr->flat[idx];
+    memset(n, 0, sizeof(tree_node_t));
+    n->name = Qnil;
+    n->parent = parent;
+    n->first_child = NO_NODE;
+    n->next_sibling = NO_NODE;
+    tr->flat_len++;
+    rb_ary_push(tr->nodes, node);
+
+    // Only tags have children; other nodes leave @children undefined.
+    const VALUE children = rb_ivar_get(node, id_ivar_children);
+    if (RB_TYPE_P(children, T_ARRAY)) {
+        n->name = rb_ivar_get(node, id_ivar_name);
+        tree_push_attrs(tr, n, rb_ivar_get(node, id_ivar_attributes));
+
+        long prev = NO_NODE;
+        const long len = RARRAY_LEN(children);
+        for (long i = 0; i < len; i++) {
+            const VALUE child = rb_ary_entry(children, i);
+            if (NIL_P(child)) continue;
+            const long c = tree_push(tr, child, idx);
+            if (prev == NO_NODE) {
+                tr->flat[idx].first_child = c;
+            } else {
+                tr->flat[prev].next_sibling = c;
+            }
+            prev = c;
+        }
+    }
+
+    tr->flat[idx].subtree_end = tr->flat_len;
+    return idx;
+}
+
+static VALUE tree_initialize(const VALUE self, const VALUE ast) {
+    Check_Type(ast, T_ARRAY);
+    UNWRAP_TREE;
+    tr->nodes = rb_ary_new();
+    tr->flat_len = 0;
+    tr->attrs_len = 0;
+
+    long prev = NO_NODE;
+    const long len = RARRAY_LEN(ast);
+    for (long i = 0; i < len; i++) {
+        const VALUE node = rb_ary_entry(ast, i);
+        if (NIL_P(node)) continue;
+        const long idx = tree_push(tr, node, NO_NODE);
+        if (prev != NO_NODE) tr->flat[prev].next_sibling = idx;
+        prev = idx;
+    }
+    rb_ary_freeze(tr->nodes);
+    return self;
+}
+
+static long tree_check_index(const tree_t *tr, const VALUE index) {
+    const long i = NUM2LONG(index);
+    if (i < 0 || i >= tr->flat_len) {
+        rb_raise(rb_eIndexError, "node index %ld out of range", i);
+    }
+    return i;
+}
+
+static inline VALUE tree_index_value(const long i) {
+    return i == NO_NODE ? Qnil : LONG2FIX(i);
+}
+
+static VALUE tree_size(const VALUE self) {
+    UNWRAP_TREE;
+    return LONG2FIX(tr->flat_len);
+}
+
+static VALUE tree_nodes(const VALUE self) {
+    UNWRAP_TREE;
+    return tr->nodes;
+}
+
+static VALUE tree_aref(const VALUE self, const VALUE index) {
+    UNWRAP_TREE;
+    return rb_ary_entry(tr->nodes, tree_check_index(tr, index));
+}
+
+static VALUE tree_parent(const VALUE self, const VALUE index) {
+    UNWRAP_TREE;
+    return tree_index_value(tr->flat[tree_check_index(tr, index)].parent);
+}
+
+static VALUE tree_first_child(const VALUE self, const VALUE index) {
+    UNWRAP_TREE;
+    return tree_index_value(tr->flat[tree_check_index(tr, index)].first_child);
+}
+
+static VALUE tree_next_sibling(const VALUE self, const VALUE index) {
+    UNWRAP_TREE;
+    return tree_index_value(tr->flat[tree_check_index(tr, index)].next_sibling);
+}
+
+static VALUE tree_subtree_end(const VALUE self, const VALUE index) {
+    UNWRAP_TREE;
+    return LONG2FIX(tr->flat[tree_check_index(tr, index)].subtree_end);
+}
+
+static VALUE tree_enum_size(const VALUE self, VALUE args, VALUE eobj) {
+    return tree_size(self);
+}
+
+static VALUE tree_each_node(const VALUE self) {
+    RETURN_SIZED_ENUMERATOR(self, 0, 0, tree_enum_size);
+    UNWRAP_TREE;
+    for (long i = 0; i < tr->flat_len; i++) {
+        rb_yield_values(2, rb_ary_entry(tr->nodes, i), LONG2FIX(i));
+    }
+    return self;
+}
+
+// Names and keys coming from the scanner are interned, so identity almost
+// always settles it; the comparison only covers strings built elsewhere.
+static inline bool tree_same_str(const VALUE a, const VALUE b) {
+    return a == b || (RB_TYPE_P(a, T_STRING) && rb_str_equal(a, b) == Qtrue);
+}
+
+static VALUE tree_query_str(VALUE v) {
+    if (SYMBOL_P(v)) return rb_sym2str(v);
+    StringValue(v);
+    return rb_str_to_interned_str(v);
+}
+
+// Returns whether node n has an attribute with the given key and, unless
+// literal is Qundef, whether its value literal equals literal.
+static bool tree_node_has_attr(const tree_t *tr, const tree_node_t *n, const VALUE key, const VALUE literal) {
+    for (long i = n->attr_start; i < n->attr_start + n->attr_len; i++) {
+        const tree_attr_t *a = &tr->attrs[i];
+        if (!tree_same_str(a->key, key)) continue;
+        if (literal == Qundef) return true;
+        if (!NIL_P(a->literal) && rb_str_equal(a->literal, literal) == Qtrue) return true;
+    }
+    return false;
+}
+
+typedef struct {
+    const tree_t *tr;
+    const tree_node_t *n;
+    bool matches;
+} tree_attr_match_t;
+
+static int tree_attr_match_i(const VALUE key, const VALUE value, const VALUE arg) {
+    tree_attr_match_t *m = (tree_attr_match_t *) arg;
+    const VALUE literal = value == Qtrue ? Qundef : value;
+    m->matches = tree_node_has_attr(m->tr, m->n, tree_query_str(key), literal);
+    return m->matches ? ST_CONTINUE : ST_STOP;
+}
+
+// find_all(name: nil, attr: nil, within: nil)
+//
+// Returns the nodes matching every given predicate, in document order.
+//   name:   tag name (String or Symbol).
+//   attr:   attribute key that must be present, or a Hash of key => literal,
+//           where `true` only requires the key to be present.
+//   within: restricts the search to the descendants of that node index.
+static VALUE tree_find_all(const int argc, VALUE *argv, const VALUE self) {
+    UNWRAP_TREE;
+    VALUE opts = Qnil;
+    VALUE kwargs[3] = {Qundef, Qundef, Qundef};
+    rb_scan_args(argc, argv, ":", &opts);
+    if (!NIL_P(opts)) {
+        const ID kw[3] = {id_type_name, id_type_attr, id_type_within};
+        rb_get_kwargs(opts, kw, 0, 3, kwargs);
+    }
+
+    const VALUE name = kwargs[0] == Qundef || NIL_P(kwargs[0]) ? Qundef : tree_query_str(kwargs[0]);
+    VALUE attr_key = Qundef, attr_hash = Qundef;
+    if (kwargs[1] != Qundef && !NIL_P(kwargs[1])) {
+        if (RB_TYPE_P(kwargs[1], T_HASH)) {
+            attr_hash = kwargs[1];
+        } else {
+            attr_key = tree_query_str(kwargs[1]);
+        }
+    }
+
+    long from = 0, to = tr->flat_len;
+    if (kwargs[2] != Qundef && !NIL_P(kwargs[2])) {
+        from = tree_check_index(tr, kwargs[2]);
+        to = tr->flat[from].subtree_end;
+        from++;
+    }
+
+    const VALUE result = rb_ary_new();
+    for (long i = from; i < to; i++) {
+        const tree_node_t *n = &tr->flat[i];
+        if (name != Qundef && !tree_same_str(n->name, name)) continue;
+        if (attr_key != Qundef && !tree_node_has_attr(tr, n, attr_key, Qundef)) continue;
+        if (attr_hash != Qundef) {
+            if (NIL_P(n->name)) continue;
+            tree_attr_match_t m = {tr, n, true};
+            rb_hash_foreach(attr_hash, tree_attr_match_i, (VALUE) &m);
+            if (!m.matches) continue;
+        }
+        rb_ary_push(result, rb_ary_entry(tr->nodes, i));
+    }
+    return result;
+}
+
+RUBY_FUNC_EXPORTED void Init_minihtml_tree(void) {
+    const VALUE mMiniHTML = rb_define_module("MiniHTML");
+    const VALUE cTree = rb_define_class_under(mMiniHTML, "FlatTree", rb_cObject);
+
+    INITIALIZE_REUSABLE_SYMBOL(name);
+    INITIALIZE_REUSABLE_SYMBOL(attr);
+    INITIALIZE_REUSABLE_SYMBOL(within);
+
+    id_ivar_name = rb_intern("@name");
+    id_ivar_children = rb_intern("@children");
+    id_ivar_attributes = rb_intern("@attributes");
+    id_ivar_value = rb_intern("@value");
+    id_ivar_literal = rb_intern("@literal");
+
+    rb_define_alloc_func(cTree, tree_alloc);
+    rb_define_method(cTree, "initialize", tree_initialize, 1);
+    rb_define_method(cTree, "size", tree_size, 0);
+    rb_define_method(cTree, "nodes", tree_nodes, 0);
+    rb_define_method(cTree, "[]", tree_aref, 1);
+    rb_define_method(cTree, "parent", tree_parent, 1);
+    rb_define_method(cTree, "first_child", tree_first_child, 1);
+    rb_define_method(cTree, "next_sibling", tree_next_sibling, 1);
+    rb_define_method(cTree, "subtree_end", tree_subtree_end, 1);
+    rb_define_method(cTree, "each_node", tree_each_node, 0);
+    rb_define_method(cTree, "find_all", tree_find_all, -1);
+}
@@ -1,11 +1,20 @@
 # frozen_string_literal: true
 
 require_relative "minihtml/version"
-require_relative "minihtml/minihtml_scanner"
-require_relative "minihtml/minihtml_token_stream"
+
+# `rake optimize` builds every extension into a single PGO-tuned library;
+# prefer it when present. A plain `rake compile` removes it again.
+begin
+  require_relative "minihtml/minihtml_native"
+rescue LoadError
+  require_relative "minihtml/minihtml_scanner"
+  require_relative "minihtml/minihtml_token_stream"
+  require_relative "minihtml/minihtml_tree"
+end
 
 require_relative "minihtml/ast"
 require_relative "minihtml/parser"
+require_relative "minihtml/index"
 
 module MiniHTML
   class Error < StandardError; end
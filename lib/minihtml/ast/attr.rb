@@ -6,7 +6,7 @@ module MiniHTML
       attr_accessor :name
       attr_reader :value
 
-      def initialize(token)
+      def initialize(token, lines = nil)
         super
         @name = token[:literal]
         @value = nil
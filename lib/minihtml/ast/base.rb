@@ -5,10 +5,10 @@ module MiniHTML
     class Base
       attr_reader :position_start, :position_end, :original_token
 
-      def initialize(token)
+      def initialize(token, lines = nil)
         @original_token = token
-        @position_start = Position.new(line: token[:start_line], column: token[:start_column], offset: token[:start_offset])
-        @position_end = Position.new(line: token[:end_line], column: token[:end_column], offset: token[:end_offset])
+        @position_start = Position.new(offset: token[:start_offset], lines:)
+        @position_end = Position.new(offset: token[:end_offset], lines:)
       end
     end
   end
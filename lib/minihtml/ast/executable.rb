@@ -5,7 +5,7 @@ module MiniHTML
     class Executable < Base
       attr_accessor :source
 
-      def initialize(token)
+      def initialize(token, lines = nil)
         super
         @source = token[:literal]
       end
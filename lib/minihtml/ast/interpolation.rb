@@ -5,9 +5,9 @@ module MiniHTML
     class Interpolation < Base
       attr_accessor :values
 
-      def initialize(token)
+      def initialize(token, lines = nil)
         super
-        @values = [AST::String.new(token)]
+        @values = [AST::String.new(token, lines)]
       end
     end
   end
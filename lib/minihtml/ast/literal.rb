@@ -5,7 +5,7 @@ module MiniHTML
     class Literal < Base
       attr_accessor :value
 
-      def initialize(token)
+      def initialize(token, lines = nil)
         super
         @value = token[:literal]
       end
@@ -5,7 +5,7 @@ module MiniHTML
     class PlainText < Base
       attr_accessor :literal
 
-      def initialize(token)
+      def initialize(token, lines = nil)
         super
         @literal = token[:literal]
       end
@@ -3,12 +3,41 @@
 module MiniHTML
   module AST
     class Position
-      attr_reader :line, :column, :offset
+      attr_reader :offset
 
-      def initialize(line:, column:, offset:)
+      # Positions created by the parser only know their offset; line and
+      # column are resolved through the LineIndex on first access.
+      def initialize(offset:, line: nil, column: nil, lines: nil)
         @line = line
         @column = column
         @offset = offset
+        @lines = lines
+      end
+
+      def line
+        resolve unless @line
+        @line
+      end
+
+      def column
+        resolve unless @column
+        @column
+      end
+
+      # The LineIndex is native and cannot be dumped, so serialised positions
+      # carry their resolved line and column instead.
+      def marshal_dump
+        [offset, line, column]
+      end
+
+      def marshal_load(data)
+        @offset, @line, @column = data
+      end
+
+      private
+
+      def resolve
+        @line, @column = @lines&.line_column(offset)
       end
     end
   end
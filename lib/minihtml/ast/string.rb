@@ -5,7 +5,7 @@ module MiniHTML
     class String < Base
       attr_accessor :quote, :literal
 
-      def initialize(token)
+      def initialize(token, lines = nil)
         super
         @literal = token[:literal].gsub(/\\#{token[:quote_char]}/, token[:quote_char])
         @quote = token[:quote_char]
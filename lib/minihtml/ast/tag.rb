@@ -7,15 +7,10 @@ module MiniHTML
       alias self_closing? self_closing
       alias bad_tag? bad_tag
 
-      def initialize(token)
+      def initialize(token, lines = nil)
         super
-        lit = token[:literal]
-        if lit.start_with? "</"
-          @bad_tag = true
-          @name = token[:literal][2...]
-        else
-          @name = token[:literal][1...]
-        end
+        @bad_tag = true if token[:kind] == :tag_closing_start
+        @name = token[:name]
 
         @self_closing = false
         @attributes = []
@@ -0,0 +1,87 @@
+# frozen_string_literal: true
+
+require "digest"
+
+module MiniHTML
+  # Returns every tag name referenced by the given source, mapped to the
+  # number of occurrences and the position of the first one. Only tag names
+  # are recorded; no tokens or AST nodes are built.
+  def self.index(source)
+    Scanner.new(source).index
+  end
+
+  # Batch form of MiniHTML.index, returning a Hash of path => references.
+  def self.index_files(paths)
+    paths.to_h { |file| [file, index(Index.read(file))] }
+  end
+
+  # Index keeps the tag references of a set of templates in a file on disk.
+  # Each #update only rescans templates whose modification time or size
+  # changed and whose contents no longer match the recorded digest.
+  class Index
+    FORMAT_VERSION = 1
+
+    attr_reader :path, :entries
+
+    def self.read(path)
+      File.binread(path).force_encoding(Encoding::UTF_8)
+    end
+
+    def initialize(path)
+      @path = path
+      @entries = load
+    end
+
+    # Brings the index up to date with the given template paths, dropping
+    # entries for paths no longer present, and saves it. Returns the paths
+    # whose references were added, changed, or removed.
+    def update(paths)
+      changed = []
+      paths.each do |file|
+        stat = File.stat(file)
+        entry = @entries[file]
+        next if entry && entry[:mtime] == stat.mtime && entry[:size] == stat.size
+
+        source = Index.read(file)
+        digest = Digest::SHA256.hexdigest(source)
+        if entry && entry[:digest] == digest
+          entry[:mtime] = stat.mtime
+          entry[:size] = stat.size
+          next
+        end
+
+        @entries[file] = { mtime: stat.mtime, size: stat.size, digest:, references: MiniHTML.index(source) }
+        changed << file
+      end
+
+      removed = @entries.keys - paths.to_a
+      removed.each { |file| @entries.delete(file) }
+      save
+      changed + removed
+    end
+
+    def references(file)
+      @entries.dig(file, :references)
+    end
+
+    # Returns the indexed paths referencing the given tag name.
+    def dependents(name)
+      @entries.filter_map { |file, entry| file if entry[:references].key?(name) }
+    end
+
+    def save
+      tmp = "#{path}.#{Process.pid}.tmp"
+      File.binwrite(tmp, Marshal.dump({ version: FORMAT_VERSION, entries: @entries }))
+      File.rename(tmp, path)
+    end
+
+    private
+
+    def load
+      return {} unless File.exist?(path)
+
+      data = Marshal.load(File.binread(path)) # rubocop:disable Security/MarshalLoad
+      data.is_a?(Hash) && data[:version] == FORMAT_VERSION ? data[:entries] : {}
+    end
+  end
+end
@@ -5,10 +5,12 @@ module MiniHTML
     attr_reader :stream
 
     def initialize(source)
-      scanner = MiniHTML::Scanner.new(source)
+      # Any error aborts parsing, so there's no point in scanning past the first.
+      scanner = MiniHTML::Scanner.new(source, fail_fast: true)
       tokens = scanner.tokenize
-      raise ParseError.new(*scanner.errors) unless scanner.errors.empty?
+      raise ParseError.new(*scanner.errors) if scanner.errors?
 
+      @lines = scanner.line_index
       @stream = MiniHTML::TokenStream.new(tokens)
       @tokens = []
     end
@@ -21,7 +23,7 @@ module MiniHTML
     def parse_one
       case stream.peek_kind
       when :literal
-        AST::PlainText.new(stream.consume)
+        AST::PlainText.new(stream.consume, @lines)
       when :tag_begin
         if stream.peek[:literal] == "<!--"
           parse_comment
@@ -29,15 +31,15 @@ module MiniHTML
           parse_tag
         end
       when :attr_value_unquoted
-        AST::Literal.new(stream.consume)
+        AST::Literal.new(stream.consume, @lines)
       when :string
-        AST::String.new(stream.consume)
+        AST::String.new(stream.consume, @lines)
       when :executable
-        AST::Executable.new(stream.consume)
+        AST::Executable.new(stream.consume, @lines)
       when :string_interpolation
         parse_string_interpolation
       when :tag_closing_start
-        tag = AST::Tag.new(stream.consume)
+        tag = AST::Tag.new(stream.consume, @lines)
         discard_until_tag_end
         tag
       else
@@ -47,22 +49,22 @@ module MiniHTML
 
     def parse_comment
       stream.consume
-      AST::Comment.new(stream.consume) unless stream.empty?
+      AST::Comment.new(stream.consume, @lines) unless stream.empty?
     end
 
     def parse_string_interpolation
-      interp = AST::Interpolation.new(stream.consume)
+      interp = AST::Interpolation.new(stream.consume, @lines)
       until stream.empty?
         case stream.peek_kind
         when :executable
           interp.values << parse_one
         when :string_interpolation
-          interp.values << AST::String.new(stream.consume)
+          interp.values << AST::String.new(stream.consume, @lines)
         when :string
-          interp.values << AST::String.new(stream.consume)
+          interp.values << AST::String.new(stream.consume, @lines)
           return interp
         when :interpolated_executable
-          interp.values << AST::Executable.new(stream.consume)
+          interp.values << AST::Executable.new(stream.consume, @lines)
         else
           raise "Unexpected token type #{stream.peek_kind} on #parse_string_interpolation"
         end
@@ -76,7 +78,7 @@ module MiniHTML
     end
 
     def parse_tag
-      tag = AST::Tag.new(stream.consume)
+      tag = AST::Tag.new(stream.consume, @lines)
       until stream.empty?
         case stream.peek_kind
         when :right_angled
@@ -84,7 +86,9 @@ module MiniHTML
           # This tag has children...
           tag.children << parse_one until stream.peek_kind == :tag_closing_start || stream.empty?
         when :tag_closing_start
-          if stream.peek[:literal][2...] == tag.name
+          # Tag names are interned by the scanner, so matching the closing
+          # tag is an identity check.
+          if stream.peek[:name].equal?(tag.name)
             # Consume everything until a closing_end
             discard_until_tag_end
             return tag
@@ -102,7 +106,7 @@ module MiniHTML
     end
 
     def parse_attr
-      att = AST::Attr.new(stream.consume)
+      att = AST::Attr.new(stream.consume, @lines)
       return att unless stream.peek_kind == :equal
 
       stream.consume # equal
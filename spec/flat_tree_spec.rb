@@ -0,0 +1,58 @@
+# frozen_string_literal: true
+
+RSpec.describe "FlatTree" do
+  let(:source) do
+    <<~HTML.strip
+      <ul class="list" id=main><li class="a">x</li><li data-on>{{y}}</li></ul><!-- c --><Foo::Bar open={{z}} />
+    HTML
+  end
+
+  let(:tree) { MiniHTML::FlatTree.new(MiniHTML::Parser.new(source).parse) }
+
+  it "stores nodes in pre-order with structural indices" do
+    expect(tree.size).to eq 7
+    expect(tree.each_node.map { |node, _| node.class }).to eq [
+      MiniHTML::AST::Tag, MiniHTML::AST::Tag, MiniHTML::AST::PlainText,
+      MiniHTML::AST::Tag, MiniHTML::AST::Executable,
+      MiniHTML::AST::Comment, MiniHTML::AST::Tag
+    ]
+
+    expect(tree.first_child(0)).to eq 1
+    expect(tree.next_sibling(1)).to eq 3
+    expect(tree.next_sibling(3)).to be_nil
+    expect(tree.parent(4)).to eq 3
+    expect(tree.parent(0)).to be_nil
+    expect(tree.next_sibling(0)).to eq 5
+    expect(tree.subtree_end(0)).to eq 5
+  end
+
+  it "finds nodes by name, attributes and subtree" do
+    expect(tree.find_all(name: "li").length).to eq 2
+    expect(tree.find_all(name: :"Foo::Bar").map(&:name)).to eq ["Foo::Bar"]
+    expect(tree.find_all(attr: "class").map(&:name)).to eq %w[ul li]
+    expect(tree.find_all(attr: { "class" => "a" }).map(&:name)).to eq ["li"]
+    expect(tree.find_all(attr: { id: "main", "data-on": true })).to be_empty
+    expect(tree.find_all(name: "li", attr: "data-on", within: 0).length).to eq 1
+    expect(tree.find_all(within: 1).map(&:class)).to eq [MiniHTML::AST::PlainText]
+  end
+
+  it "builds safely while the GC runs on every allocation" do
+    source = <<~HTML * 20
+      <nav class="main {{ theme }}" data-controller=app>
+        <Nav::Link href="/" active={{ home? }}>Home</Nav::Link>
+        <Nav::Link href="/users/{{ user.id }}" title="Profile">Profile</Nav::Link>
+        <Nav::Link href="/settings">Settings</Nav::Link>
+      </nav>
+    HTML
+    ast = MiniHTML::Parser.new(source).parse
+
+    GC.stress = true
+    begin
+      tree = MiniHTML::FlatTree.new(ast)
+    ensure
+      GC.stress = false
+    end
+
+    expect(tree.find_all(name: "Nav::Link").length).to eq 60
+  end
+end
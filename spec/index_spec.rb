@@ -0,0 +1,46 @@
+# frozen_string_literal: true
+
+require "tmpdir"
+
+RSpec.describe "Index" do
+  it "records tag references with counts and first positions" do
+    refs = MiniHTML.index(<<~HTML)
+      <div title="<Fake>">
+        {{ "<Nope>" }}
+        <Foo::Bar a={{b}} />
+        <Foo::Bar></Foo::Bar>
+      </div>
+    HTML
+
+    expect(refs.keys).to eq ["div", "Foo::Bar"]
+    expect(refs["div"]).to eq({ count: 1, line: 1, column: 1, offset: 0 })
+    expect(refs["Foo::Bar"]).to eq({ count: 2, line: 3, column: 3, offset: 40 })
+  end
+
+  it "updates an on-disk index incrementally" do
+    Dir.mktmpdir do |dir|
+      page = File.join(dir, "page.html")
+      card = File.join(dir, "card.html")
+      File.write(page, "<Layout><Card /></Layout>")
+      File.write(card, "<div>card</div>")
+
+      index = MiniHTML::Index.new(File.join(dir, "index.bin"))
+      expect(index.update([page, card])).to eq [page, card]
+      expect(index.dependents("Card")).to eq [page]
+
+      reloaded = MiniHTML::Index.new(index.path)
+      expect(reloaded.update([page, card])).to be_empty
+
+      File.utime(Time.now, Time.now + 5, card)
+      expect(reloaded.update([page, card])).to be_empty
+
+      File.write(card, "<div><Icon /></div>")
+      File.utime(Time.now, Time.now + 10, card)
+      expect(reloaded.update([page, card])).to eq [card]
+      expect(reloaded.references(card).keys).to eq %w[div Icon]
+
+      expect(reloaded.update([card])).to eq [page]
+      expect(reloaded.dependents("Card")).to be_empty
+    end
+  end
+end
@@ -75,4 +75,55 @@ RSpec.describe "Minimal" do
       expect(tokens.map { it[:kind] }).to eq(test_case[:expected_kinds])
     end
   end
+
+  it "only materializes requested token kinds" do
+    source = "<div title=\"Hi {{name}}\" value={{foo}}><!-- note --><Foo::Bar/>{{ bar }}</div>"
+    tokens = MiniHTML::Scanner.new(source).tokenize(only: %i[executable tag_begin])
+
+    expect(tokens.map { [it[:kind], it[:literal]] }).to eq [
+      [:tag_begin, "<div"],
+      [:executable, "foo"],
+      [:tag_begin, "<!--"],
+      [:tag_begin, "<Foo::Bar"],
+      [:executable, " bar "]
+    ]
+  end
+
+  it "materializes no tokens when no kinds are requested" do
+    inst = MiniHTML::Scanner.new("<div title=\"x\">{{ y }}</div>")
+    expect(inst.tokenize(only: [])).to be_empty
+    expect(inst).to be_eof
+  end
+
+  it "rejects unknown token kinds on selective scans" do
+    expect { MiniHTML::Scanner.new("<div>").tokenize(only: [:bogus]) }.to raise_error(ArgumentError)
+  end
+
+  it "reports structured errors" do
+    inst = MiniHTML::Scanner.new("<div title=\"x {{ y")
+    inst.tokenize
+
+    expect(inst).to be_errors
+    expect(inst.errors).to eq [
+      "Unmatched {{ block at line 1, column 19, offset 18",
+      "Unterminated string value at line 1, column 19, offset 18"
+    ]
+    expect(inst.error_details.map { it[:code] }).to eq %i[unmatched_executable unterminated_string]
+  end
+
+  it "stops at the first error when failing fast" do
+    inst = MiniHTML::Scanner.new("<div title=\"x {{ y", fail_fast: true)
+    inst.tokenize(only: [])
+
+    expect(inst.error_details).to eq [{ code: :unmatched_executable, line: 1, column: 19, offset: 18 }]
+
+    ["<a b=\"x\n{{ y", "<a b=\"x", "<!-- abc"].each do |source|
+      inst = MiniHTML::Scanner.new(source, fail_fast: true)
+      tokens = inst.tokenize
+      offset = inst.error_details.first[:offset]
+
+      expect(tokens).not_to be_empty
+      expect(tokens.map { it[:end_offset] }).to all(be < offset)
+    end
+  end
 end
@@ -82,4 +82,42 @@ RSpec.describe "Parsing" do
     expect(tag.children).to be_empty
     expect(tag).to be_self_closing
   end
+
+  it "shares interned tag names and attribute keys across documents" do
+    first = MiniHTML::Parser.new("<p>ação <Foo::Bar class=\"a\"></Foo::Bar></p>").parse.first
+    second = MiniHTML::Parser.new("<Foo::Bar class={{b}} />").parse.first
+
+    inner = first.children[1]
+    expect(inner.name).to eq "Foo::Bar"
+    expect(inner.name).to be_frozen
+    expect(inner.name).to be second.name
+    expect(inner.attributes[0].name).to eq "class"
+    expect(inner.attributes[0].name).to be second.attributes[0].name
+  end
+
+  it "resolves positions lazily from offsets" do
+    source = "<div>\n  ação\n  <Banner\n    title=\"x\" />\n</div>"
+    scanner = MiniHTML::Scanner.new(source)
+    tokens = scanner.tokenize
+    expect(tokens.first.keys).to contain_exactly(:kind, :start_offset, :end_offset, :literal, :name)
+
+    banner = MiniHTML::Parser.new(source).parse.first.children[1]
+    expect(banner.position_start.offset).to eq 15
+    expect(banner.position_start.line).to eq 3
+    expect(banner.position_start.column).to eq 3
+
+    title = banner.attributes.first
+    expect([title.position_start.line, title.position_start.column]).to eq [4, 5]
+    expect(scanner.line_column(title.position_start.offset)).to eq [4, 5]
+  end
+
+  it "round-trips a parsed tree through Marshal" do
+    ast = Marshal.load(Marshal.dump(MiniHTML::Parser.new("<div a=\"b\">\n<p>x</p></div>").parse))
+
+    inner = ast.first.children[1]
+    expect(inner.name).to eq "p"
+    expect([inner.position_start.line, inner.position_start.column]).to eq [2, 1]
+    expect(inner.position_start.offset).to eq 12
+    expect(ast.first.attributes.first.position_start.line).to eq 1
+  end
 end